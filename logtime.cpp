@@ -24,6 +24,7 @@ namespace sdlog
   LogTime::LogTime(){
       RTC_DS1307();
       this->prefix = ' ';
+      this->rollover = Rollover::monthly;
       return;
   }
 
@@ -33,7 +34,11 @@ namespace sdlog
 
   String LogTime::iso_now(bool filesys, bool brackets) const
   {
-    DateTime currentTime {now()};
+    return iso(now(), filesys, brackets);
+  }
+
+  String LogTime::iso(const DateTime& currentTime, bool filesys, bool brackets) const
+  {
     String out {""};
     char timeseparator {':'};
 
@@ -63,18 +68,57 @@ namespace sdlog
 
   String LogTime::current_filename() const
   {
-    DateTime currentTime {now()};
+    return filename(now());
+  }
+
+  // File name of the period containing stamp, kept within 8.3 for the SD library:
+  //   monthly: [prefix]YYYY-MM.csv
+  //   daily:   [prefix]YYMMDD.csv
+  //   weekly:  [prefix]YYMMDD.csv, dated by the monday of the week
+  String LogTime::filename(const DateTime& stamp) const
+  {
     String out{};
 
     if(this->prefix != ' ')
       out += prefix;
 
-    out += zerofill(currentTime.year(), 4) + "-" + zerofill(currentTime.month(), 2);
+    if(rollover == Rollover::monthly)
+    {
+      out += zerofill(stamp.year(), 4) + "-" + zerofill(stamp.month(), 2);
+    }
+    else
+    {
+      DateTime day{stamp};
+      if(rollover == Rollover::weekly)
+        day = DateTime(stamp.unixtime() - ((stamp.dayOfTheWeek() + 6) % 7) * 86400UL);
+
+      out += zerofill(day.year() % 100, 2);
+      out += zerofill(day.month(), 2);
+      out += zerofill(day.day(), 2);
+    }
     out += ".csv";
 
     return out;
   }
 
+  // Number of the log period containing stamp, changes exactly when filename() does
+  unsigned long LogTime::period(const DateTime& stamp) const
+  {
+    constexpr unsigned long secondsPerDay{86400UL};
+
+    switch(rollover)
+    {
+      case Rollover::daily:
+        return stamp.unixtime() / secondsPerDay;
+      case Rollover::weekly:
+        // 1970-01-01 was a thursday: shift by 3 days to let weeks start on monday
+        return (stamp.unixtime() / secondsPerDay + 3) / 7;
+      case Rollover::monthly:
+      default:
+        return stamp.year() * 12UL + stamp.month();
+    }
+  }
+
   String LogTime::year_month() const{
     DateTime currentTime = now();
     String out = "";
@@ -124,6 +168,12 @@ namespace sdlog
     return;
   }
 
+  void LogTime::set_rollover(Rollover rollover)
+  {
+    this->rollover = rollover;
+    return;
+  }
+
   void LogTime::append_separator(String& text) const
   {
     text.concat(';');
@@ -25,19 +25,31 @@
 
 namespace sdlog
 {
+    // period covered by one log file
+    enum class Rollover : unsigned char {
+        daily,
+        weekly,
+        monthly
+    };
+
     class LogTime : public RTC_DS1307{
         public:
             LogTime();
             ~LogTime();
             String iso_now(bool filesys = false, bool brackets = false) const;
+            String iso(const DateTime& stamp, bool filesys = false, bool brackets = false) const;
             String current_filename() const;
+            String filename(const DateTime& stamp) const;
+            unsigned long period(const DateTime& stamp) const;
             String year_month() const;
             String year() const;
             String zerofill(int value, int numZero = 1) const;
             void set_prefix(char prefix);
+            void set_rollover(Rollover rollover);
             void append_separator(String& text) const;
         private:
             char prefix;
+            Rollover rollover;
     };
 
 }
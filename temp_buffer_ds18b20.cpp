@@ -0,0 +1,203 @@
+/*! @file temp_buffer_ds18b20.cpp
+ *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
+ *! @version 1.0
+ *! @date 2026-10-19
+ *! @copyright GPLv3
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "temp_buffer_ds18b20.h"
+
+namespace temp_log
+{
+    OfflineBuffer::OfflineBuffer(RTC_DS1307& rtc) : rtc(rtc)
+    {
+        head = 0;
+        count = 0;
+        num_written = 0;
+        file_size = 0;
+        return;
+    }
+
+    // Load head and count from NVRAM, start empty if NVRAM holds no buffer
+    // or one with a different slot layout
+    void OfflineBuffer::begin()
+    {
+        if((rtc.readnvram(buffer::_NVRAM_MAGIC) != buffer::_MAGIC)
+           || (rtc.readnvram(buffer::_NVRAM_LAYOUT) != buffer::_SLOT_SIZE))
+        {
+            head = 0;
+            count = 0;
+            num_written = 0;
+            file_size = 0;
+            rtc.writenvram(buffer::_NVRAM_MAGIC, buffer::_MAGIC);
+            rtc.writenvram(buffer::_NVRAM_LAYOUT, buffer::_SLOT_SIZE);
+            save_header();
+            return;
+        }
+
+        head = rtc.readnvram(buffer::_NVRAM_HEAD) | (rtc.readnvram(buffer::_NVRAM_HEAD + 1) << 8);
+        count = rtc.readnvram(buffer::_NVRAM_COUNT) | (rtc.readnvram(buffer::_NVRAM_COUNT + 1) << 8);
+        num_written = rtc.readnvram(buffer::_NVRAM_WRITTEN) | (rtc.readnvram(buffer::_NVRAM_WRITTEN + 1) << 8);
+        rtc.readnvram(reinterpret_cast<unsigned char*>(&file_size), sizeof(file_size), buffer::_NVRAM_FILE_SIZE);
+
+        if((head >= capacity()) || (count > capacity()) || (num_written > count))
+        {
+            head = 0;
+            count = 0;
+            num_written = 0;
+            file_size = 0;
+            save_header();
+        }
+        return;
+    }
+
+    // Append a sample, overwriting the oldest one when the buffer is full
+    void OfflineBuffer::push(const DateTime& stamp, const float temperature[_NUM_SENSORS_MAX])
+    {
+        BufferedSample sample{};
+        sample.stamp = stamp.unixtime();
+        for(unsigned char i{0}; i < _NUM_SENSORS_MAX; ++i)
+        {
+            sample.centi[i] = (int16_t) lround(temperature[i] * 100.f);
+        }
+
+        write_slot((head + count) % capacity(), sample);
+
+        if(count < capacity())
+        {
+            ++count;
+        }
+        else
+        {
+            head = (head + 1) % capacity();
+            if(num_written > 0)
+                --num_written;
+        }
+
+        save_header();
+        return;
+    }
+
+    // Read the sample at index, counted from the oldest one
+    bool OfflineBuffer::read(unsigned int index, DateTime& stamp, float temperature[_NUM_SENSORS_MAX]) const
+    {
+        if(index >= count)
+            return false;
+
+        BufferedSample sample{};
+        read_slot((head + index) % capacity(), sample);
+
+        stamp = DateTime(sample.stamp);
+        for(unsigned char i{0}; i < _NUM_SENSORS_MAX; ++i)
+        {
+            temperature[i] = sample.centi[i] / 100.f;
+        }
+        return true;
+    }
+
+    // Drop the num oldest samples, e.g. after they have been written to SD
+    void OfflineBuffer::discard(unsigned int num)
+    {
+        if(num > count)
+            num = count;
+
+        head = (head + num) % capacity();
+        count -= num;
+        num_written = (num < num_written) ? (num_written - num) : 0;
+
+        save_header();
+        return;
+    }
+
+    // Mark the num oldest samples as written, the log file has file_size bytes afterwards
+    void OfflineBuffer::set_written(unsigned int num, uint32_t file_size)
+    {
+        num_written = (num < count) ? num : count;
+        this->file_size = file_size;
+
+        save_header();
+        return;
+    }
+
+    unsigned int OfflineBuffer::written() const
+    {
+        return num_written;
+    }
+
+    uint32_t OfflineBuffer::written_file_size() const
+    {
+        return file_size;
+    }
+
+    unsigned int OfflineBuffer::size() const
+    {
+        return count;
+    }
+
+    unsigned int OfflineBuffer::capacity() const
+    {
+        return buffer::_SLOTS_NVRAM + buffer::_SLOTS_EEPROM;
+    }
+
+    void OfflineBuffer::read_slot(unsigned int slot, BufferedSample& sample) const
+    {
+        unsigned char* data{ reinterpret_cast<unsigned char*>(&sample) };
+
+        if(slot < buffer::_SLOTS_NVRAM)
+        {
+            rtc.readnvram(data, buffer::_SLOT_SIZE, buffer::_NVRAM_SLOTS + slot * buffer::_SLOT_SIZE);
+            return;
+        }
+
+        unsigned int address{ (slot - buffer::_SLOTS_NVRAM) * buffer::_SLOT_SIZE };
+        for(unsigned char i{0}; i < buffer::_SLOT_SIZE; ++i)
+        {
+            data[i] = EEPROM.read(address + i);
+        }
+        return;
+    }
+
+    void OfflineBuffer::write_slot(unsigned int slot, const BufferedSample& sample)
+    {
+        const unsigned char* data{ reinterpret_cast<const unsigned char*>(&sample) };
+
+        if(slot < buffer::_SLOTS_NVRAM)
+        {
+            rtc.writenvram(buffer::_NVRAM_SLOTS + slot * buffer::_SLOT_SIZE, const_cast<unsigned char*>(data), buffer::_SLOT_SIZE);
+            return;
+        }
+
+        // update() skips bytes that already hold the value and saves erase cycles
+        unsigned int address{ (slot - buffer::_SLOTS_NVRAM) * buffer::_SLOT_SIZE };
+        for(unsigned char i{0}; i < buffer::_SLOT_SIZE; ++i)
+        {
+            EEPROM.update(address + i, data[i]);
+        }
+        return;
+    }
+
+    void OfflineBuffer::save_header()
+    {
+        unsigned char header[10]{
+            (unsigned char)(head & 0xff), (unsigned char)(head >> 8),
+            (unsigned char)(count & 0xff), (unsigned char)(count >> 8),
+            (unsigned char)(num_written & 0xff), (unsigned char)(num_written >> 8),
+            (unsigned char)(file_size & 0xff), (unsigned char)(file_size >> 8),
+            (unsigned char)(file_size >> 16), (unsigned char)(file_size >> 24)
+        };
+        rtc.writenvram(buffer::_NVRAM_HEAD, header, sizeof(header));
+        return;
+    }
+}
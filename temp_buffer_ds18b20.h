@@ -0,0 +1,87 @@
+/*! @file temp_buffer_ds18b20.h
+ *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
+ *! @version 1.0
+ *! @date 2026-10-19
+ *! @brief Ring buffer for temperature samples in DS1307 NVRAM and AVR EEPROM while the SD card is missing
+ *! @copyright GPLv3
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _TEMP_DS18B20_BUFFER_H_
+#define _TEMP_DS18B20_BUFFER_H_
+
+#include <RTClib.h> // RTCLib by Adafruit
+#include <EEPROM.h>
+#include "temp_settings_ds18b20.h"
+
+namespace temp_log
+{
+    // Compact sample: unix time and temperatures in 1/100 °C
+    struct BufferedSample
+    {
+        uint32_t stamp;
+        int16_t centi[_NUM_SENSORS_MAX];
+    };
+
+    // NVRAM layout: header (magic, slot size, head, count, written, file size)
+    // followed by the first slots. The ring continues in EEPROM. Keeping head and count in battery
+    // backed NVRAM means no EEPROM cell is written more often than the ring wraps.
+    // The slot size depends on _NUM_SENSORS_MAX: a buffer written by firmware
+    // with another layout is discarded instead of being read as samples.
+    // `written` oldest samples are already in the log file, which had `file size`
+    // bytes afterwards: they are dropped once the card confirms that size.
+    namespace buffer
+    {
+        constexpr unsigned char _MAGIC{0xB5};
+        constexpr unsigned char _NVRAM_SIZE{56};
+        constexpr unsigned char _NVRAM_MAGIC{0};
+        constexpr unsigned char _NVRAM_LAYOUT{1};
+        constexpr unsigned char _NVRAM_HEAD{2};
+        constexpr unsigned char _NVRAM_COUNT{4};
+        constexpr unsigned char _NVRAM_WRITTEN{6};
+        constexpr unsigned char _NVRAM_FILE_SIZE{8};
+        constexpr unsigned char _NVRAM_SLOTS{12};
+        constexpr unsigned char _SLOT_SIZE{sizeof(BufferedSample)};
+        constexpr unsigned int _SLOTS_NVRAM{(_NVRAM_SIZE - _NVRAM_SLOTS) / _SLOT_SIZE};
+        constexpr unsigned int _SLOTS_EEPROM{(E2END + 1) / _SLOT_SIZE};
+    }
+
+    class OfflineBuffer
+    {
+        public:
+            explicit OfflineBuffer(RTC_DS1307& rtc);
+            ~OfflineBuffer() = default;
+            void begin();
+            void push(const DateTime& stamp, const float temperature[_NUM_SENSORS_MAX]);
+            bool read(unsigned int index, DateTime& stamp, float temperature[_NUM_SENSORS_MAX]) const;
+            void discard(unsigned int num);
+            void set_written(unsigned int num, uint32_t file_size);
+            unsigned int written() const;
+            uint32_t written_file_size() const;
+            unsigned int size() const;
+            unsigned int capacity() const;
+        private:
+            void read_slot(unsigned int slot, BufferedSample& sample) const;
+            void write_slot(unsigned int slot, const BufferedSample& sample);
+            void save_header();
+            RTC_DS1307& rtc;
+            unsigned int head;
+            unsigned int count;
+            unsigned int num_written;
+            uint32_t file_size;
+    };
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*! @file temp_filter_ds18b20.cpp
+ *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
+ *! @version 1.0
+ *! @date 2026-10-19
+ *! @copyright GPLv3
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "temp_filter_ds18b20.h"
+
+namespace temp_log
+{
+    SampleFilter::SampleFilter()
+    {
+        clear();
+        return;
+    }
+
+    void SampleFilter::clear()
+    {
+        count = 0;
+        return;
+    }
+
+    // Store a raw reading, at most _FILTER_SAMPLES per cycle.
+    // Disconnected sensors and the power-on-reset value (85.0 °C) are rejected.
+    bool SampleFilter::push(const int16_t& raw)
+    {
+        if((raw == _RAW_DISCONNECTED) || (raw == _RAW_POWER_ON_RESET))
+            return false;
+
+        if(count >= _FILTER_SAMPLES)
+            return false;
+
+        samples[count] = raw;
+        ++count;
+
+        return true;
+    }
+
+    // Median of the buffered samples, _RAW_DISCONNECTED if there are none
+    int16_t SampleFilter::median() const
+    {
+        if(count == 0)
+            return _RAW_DISCONNECTED;
+
+        // insertion sort on a copy, the buffer holds only a handful of values
+        int16_t sorted[_FILTER_SAMPLES];
+        for(unsigned char i{0}; i < count; ++i)
+        {
+            int16_t value{ samples[i] };
+            unsigned char j{i};
+            while((j > 0) && (sorted[j - 1] > value))
+            {
+                sorted[j] = sorted[j - 1];
+                --j;
+            }
+            sorted[j] = value;
+        }
+
+        if(count % 2)
+            return sorted[count / 2];
+
+        return (int16_t)(((int32_t)sorted[count / 2 - 1] + sorted[count / 2]) / 2);
+    }
+
+    float SampleFilter::celsius() const
+    {
+        int16_t raw{ median() };
+
+        if(raw == _RAW_DISCONNECTED)
+            return _CELSIUS_DISCONNECTED;
+
+        return (float)raw / _RAW_PER_DEGREE;
+    }
+}
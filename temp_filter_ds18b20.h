@@ -0,0 +1,52 @@
+/*! @file temp_filter_ds18b20.h
+ *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
+ *! @version 1.0
+ *! @date 2026-10-19
+ *! @brief Median filter over oversampled raw DS18B20 readings
+ *! @copyright GPLv3
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _TEMP_DS18B20_FILTER_H_
+#define _TEMP_DS18B20_FILTER_H_
+
+#include "Arduino.h"
+#include "temp_settings_ds18b20.h"
+
+namespace temp_log
+{
+    // raw values are fixed point in 1/128 °C, as returned by DallasTemperature::getTemp()
+    constexpr int16_t _RAW_PER_DEGREE{128};
+    constexpr int16_t _RAW_POWER_ON_RESET{85 * _RAW_PER_DEGREE};
+    constexpr int16_t _RAW_DISCONNECTED{-7040};
+    constexpr float _CELSIUS_DISCONNECTED{-127.f};
+
+    // Samples of one measuring cycle, cleared before each cycle
+    class SampleFilter
+    {
+        public:
+            SampleFilter();
+            ~SampleFilter() = default;
+            void clear();
+            bool push(const int16_t& raw);
+            int16_t median() const;
+            float celsius() const;
+        private:
+            int16_t samples[_FILTER_SAMPLES];
+            unsigned char count;
+    };
+}
+
+#endif
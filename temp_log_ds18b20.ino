@@ -28,6 +28,9 @@
 
 
 #include "temp_sdlog_ds18b20.h" // using: SD by Arduino
+#include "temp_memstat_ds18b20.h"
+#include "temp_filter_ds18b20.h"
+#include "temp_buffer_ds18b20.h" // using: RTCLib by Adafruit, EEPROM
 #include "logtime.h" // using: RTCLib by Adafruit
 
 #include "min_time_hm.h"
@@ -49,6 +52,17 @@ enum LoopState {
 
 // LogTime clock / SD object
 sdlog::LogTime logtime;
+bool sd_available{false};
+unsigned int sd_retry_countdown{0};
+unsigned int sd_retry_cycles{1};
+unsigned int sd_checkpoint_countdown{temp_log::_SD_CHECKPOINT_CYCLES};
+
+// Samples not yet confirmed on the SD card (DS1307 NVRAM + EEPROM).
+// The oldest offline_buffer.written() of them are already in the log file.
+temp_log::OfflineBuffer offline_buffer{logtime};
+
+static_assert(temp_log::_SD_CHECKPOINT_CYCLES < temp_log::buffer::_SLOTS_NVRAM + temp_log::buffer::_SLOTS_EEPROM,
+              "samples between two SD checkpoints must fit into the offline buffer");
 
 // Temperature sensors and bus the sensors are connected to
 OneWire ow(temp_log::pin::_TEMP_SENSOR);
@@ -56,6 +70,12 @@ DallasTemperature temp_sensors(&ow);
 unsigned char num_connected_sensors{0};
 unsigned char temp_sensor_address[temp_log::_NUM_SENSORS_MAX][8]{0};
 
+// Resolution and conversion time per sensor, sensors are read fastest first
+uint8_t sensor_resolution[temp_log::_NUM_SENSORS_MAX]{0};
+uint16_t conversion_ms[temp_log::_NUM_SENSORS_MAX]{0};
+unsigned char read_order[temp_log::_NUM_SENSORS_MAX]{0};
+unsigned long bus_time_us{0}; // time spent in convert and read transactions in the last cycle
+
 // Liquid crystal display 16x4
 LiquidCrystal_I2C disp(temp_log::i2c::_LCD, 16, temp_log::_LCD_LINES);
 
@@ -70,12 +90,35 @@ LoopState last_loop_state{LoopState::initializing};
 // Temperature value buffer
 float current_temperature[temp_log::_NUM_SENSORS_MAX]{0.f};
 
+// Oversampling filter per sensor and its cost in the last cycle
+temp_log::SampleFilter temp_filter[temp_log::_NUM_SENSORS_MAX];
+unsigned long filter_time_us[temp_log::_NUM_SENSORS_MAX]{0};
+
 // For Serial logging
 char loop_state_map[]{"     "};
 
 // status of status led
 bool status_led{false};
 
+// measuring cycles left until the next memory record
+unsigned int mem_log_countdown{temp_log::_MEM_LOG_CYCLES};
+
+//////////////////////////////////////////////////////////////////////////
+// STATIC RAM PER SUBSYSTEM (the SD block cache is a static of the SD library)
+// Covers only the objects listed here: Serial and Wire buffers, library
+// internals and string literals in .data are checked at boot against
+// _RAM_BUDGET_STATIC instead.
+
+constexpr unsigned int ram_clock{sizeof(logtime)};
+constexpr unsigned int ram_sensors{sizeof(ow) + sizeof(temp_sensors) + sizeof(temp_sensor_address) + sizeof(current_temperature)
+                                   + sizeof(sensor_resolution) + sizeof(conversion_ms) + sizeof(read_order)};
+constexpr unsigned int ram_filter{sizeof(temp_filter) + sizeof(filter_time_us)};
+constexpr unsigned int ram_display{sizeof(disp)};
+constexpr unsigned int ram_sd{sizeof(SD) + sizeof(cache_t) + sizeof(offline_buffer)};
+
+static_assert(ram_clock + ram_sensors + ram_filter + ram_display + ram_sd <= temp_log::_RAM_BUDGET_OBJECTS,
+              "RAM budget of the sketch objects exceeded, see temp_settings_ds18b20.h");
+
 //////////////////////////////////////////////////////////////////////////
 // FUNCTIONS IN THIS FILE
 
@@ -83,6 +126,13 @@ void setup();
 bool setup_clock();
 bool setup_sd();
 void setup_temp_sensors();
+void setup_sensor_resolution();
+uint8_t configured_resolution(const unsigned char address[8]);
+void measure_temperatures();
+void log_cycle(const DateTime& stamp);
+bool write_backlog();
+void confirm_backlog();
+bool retry_sd();
 
 void loop();
 bool check_measure_time();
@@ -91,12 +141,17 @@ bool check_measure_time();
 void set_next_measure_time();
 void set_onboard_led(bool state);
 void update_display();
+void print_memory_report();
+void handle_serial_command();
 
 /// @fn setup
 /// @brief setup routine before running loop function
 /// @see loop
 void setup()
 {
+  // fill the free RAM with a pattern to find the stack high-water mark later on
+  temp_log::paint_stack();
+
   Serial.begin(9600);
   delay(500);
 
@@ -114,9 +169,14 @@ void setup()
     return;
   }
   logtime.set_prefix('t');
+  logtime.set_rollover(temp_log::_LOG_ROLLOVER);
+
+  if(temp_log::_OFFLINE_BUFFER)
+    offline_buffer.begin();
 
-  // setup SD card interface on SD shield
-  if(!setup_sd())
+  // setup SD card interface on SD shield, without card the samples are buffered
+  sd_available = setup_sd();
+  if(!sd_available && !temp_log::_OFFLINE_BUFFER)
   {
     Serial.println(F("E: Fatal!"));
     state = LoopState::fatalerror;
@@ -153,6 +213,8 @@ void setup()
 
   measuring_cycle.set_overflow(true);
 
+  print_memory_report();
+
   state = LoopState::check_measure;
   return;
 }
@@ -184,12 +246,16 @@ bool setup_clock()
 bool setup_sd()
 {
   // SD Logger initialisieren
-  if(!temp_log::init_sd_logging(temp_log::pin::_SD))
-    return false;
+  bool available{temp_log::init_sd_logging(temp_log::pin::_SD)};
+
+  // samples written before a reset must not be written a second time
+  if(available && temp_log::_OFFLINE_BUFFER)
+    confirm_backlog();
   
-  // Append "System boot" to file named as current month
-  temp_log::log_boot(logtime);
-  return true;
+  // Append "System boot" to file named as current month,
+  // without card it is written as soon as the card is available
+  temp_log::log_boot(logtime, logtime.now());
+  return available;
 }
 
 //! @fn setup_temp_sensors
@@ -198,6 +264,8 @@ void setup_temp_sensors()
 {
   temp_sensors.begin();
   num_connected_sensors = (unsigned char) temp_sensors.getDeviceCount();
+  if(num_connected_sensors > temp_log::_NUM_SENSORS_MAX)
+    num_connected_sensors = temp_log::_NUM_SENSORS_MAX;
   Serial.println((String) num_connected_sensors + " s"); // DEBUG
   for(unsigned char i = 0; i < temp_log::_NUM_SENSORS_MAX; ++i)
   {
@@ -214,14 +282,229 @@ void setup_temp_sensors()
     */
   }
 
+  setup_sensor_resolution();
+
+  DateTime now{logtime.now()};
+
   if(temp_log::_SD_LOGGING)
   {
-    temp_log::log_sensors(logtime, temp_sensor_address);
+    temp_log::log_sensors(logtime, now, temp_sensor_address, sensor_resolution);
+  }
+
+  if(temp_log::_SERIAL_RECORDS)
+  {
+    temp_log::print_record(temp_log::sensors_record(logtime, now, temp_sensor_address));
+    temp_log::print_record(temp_log::resolution_record(logtime, now, sensor_resolution));
+  }
+
+  return;
+}
+
+//! @brief looks up the resolution of a sensor in _SENSOR_RESOLUTION by its ROM code
+uint8_t configured_resolution(const unsigned char address[8])
+{
+  for(const temp_log::SensorResolution& entry : temp_log::_SENSOR_RESOLUTION)
+  {
+    if((entry.bits != 0) && (memcmp(entry.address, address, 8) == 0))
+      return entry.bits;
+  }
+  return temp_log::_SENSOR_RESOLUTION_DEFAULT;
+}
+
+//! @brief sets each sensor to its configured resolution and sorts the sensors by conversion time
+void setup_sensor_resolution()
+{
+  for(unsigned char i{0}; i < num_connected_sensors; ++i)
+  {
+    uint8_t bits{configured_resolution(temp_sensor_address[i])};
+
+    // setResolution() copies the scratchpad to the sensor's EEPROM,
+    // so it is only called when the resolution changes
+    if(temp_sensors.getResolution(temp_sensor_address[i]) != bits)
+      temp_sensors.setResolution(temp_sensor_address[i], bits, true);
+
+    sensor_resolution[i] = temp_sensors.getResolution(temp_sensor_address[i]);
+    conversion_ms[i] = temp_sensors.millisToWaitForConversion(sensor_resolution[i]);
+
+    // insertion sort: fastest sensor first
+    unsigned char j{i};
+    while((j > 0) && (conversion_ms[read_order[j - 1]] > conversion_ms[i]))
+    {
+      read_order[j] = read_order[j - 1];
+      --j;
+    }
+    read_order[j] = i;
+  }
+
+  // requestTemperatures() returns right away, measure_temperatures() waits per sensor
+  temp_sensors.setWaitForConversion(false);
+  return;
+}
+
+/// @brief takes _FILTER_SAMPLES conversions of all sensors and stores the filtered values
+/// @see setup_sensor_resolution
+void measure_temperatures()
+{
+  for(unsigned char i{0}; i < num_connected_sensors; ++i)
+  {
+    temp_filter[i].clear();
+  }
+
+  bus_time_us = 0;
+
+  for(unsigned char k{0}; k < temp_log::_FILTER_SAMPLES; ++k)
+  {
+    // one broadcast convert, then read each sensor as soon as its own conversion is done
+    unsigned long transfer{micros()};
+    temp_sensors.requestTemperatures();
+    bus_time_us += micros() - transfer;
+
+    // conversion windows count from the end of the convert command
+    unsigned long start{millis()};
+
+    for(unsigned char n{0}; n < num_connected_sensors; ++n)
+    {
+      unsigned char i{read_order[n]};
+      unsigned long elapsed{millis() - start};
+
+      if(elapsed < conversion_ms[i])
+        delay(conversion_ms[i] - elapsed);
+
+      transfer = micros();
+      int16_t raw{(int16_t) temp_sensors.getTemp(temp_sensor_address[i])};
+      bus_time_us += micros() - transfer;
+
+      temp_filter[i].push(raw);
+    }
+  }
+
+  for(unsigned char i{0}; i < num_connected_sensors; ++i)
+  {
+    unsigned long start{micros()};
+    current_temperature[i] = temp_filter[i].celsius();
+    filter_time_us[i] = micros() - start;
+  }
+  return;
+}
+
+/// @brief writes the current temperatures to SD, buffers them until they are confirmed on the card
+/// @param stamp time of the measurement
+void log_cycle(const DateTime& stamp)
+{
+  if(!temp_log::_OFFLINE_BUFFER)
+  {
+    if(!sd_available)
+      sd_available = retry_sd();
+
+    if(sd_available)
+      sd_available = temp_log::log_temperature(logtime, stamp, current_temperature);
+    return;
+  }
+
+  offline_buffer.push(stamp, current_temperature);
+
+  if(!sd_available)
+    sd_available = retry_sd();
+
+  if(sd_available)
+    sd_available = write_backlog();
+
+  if(sd_available && (--sd_checkpoint_countdown == 0))
+  {
+    sd_checkpoint_countdown = temp_log::_SD_CHECKPOINT_CYCLES;
+    sd_available = temp_log::confirmLog(temp_log::pin::_SD);
+
+    if(sd_available)
+      offline_buffer.discard(offline_buffer.written());
   }
 
+  if(!sd_available)
+  {
+    // nothing since the last checkpoint is known to be on the card: write it again
+    // once the card is back (records that did make it show up twice in the file)
+    offline_buffer.set_written(0, 0);
+
+    Serial.print(F("i: buffered "));
+    Serial.print(offline_buffer.size());
+    Serial.print('/');
+    Serial.println(offline_buffer.capacity());
+  }
   return;
 }
 
+/// @brief writes all buffered samples not yet in the log file to SD in one batch
+/// @return true = backlog written completely, false = SD failed in between
+bool write_backlog()
+{
+  DateTime stamp{};
+  float temperature[temp_log::_NUM_SENSORS_MAX]{0.f};
+  unsigned int first{offline_buffer.written()};
+  unsigned int written{0};
+
+  temp_log::beginLogBatch();
+  while(offline_buffer.read(first + written, stamp, temperature)
+        && temp_log::log_temperature(logtime, stamp, temperature))
+  {
+    ++written;
+  }
+  temp_log::endLogBatch();
+
+  // kept in NVRAM, so a reset does not write these samples again
+  if(written > 0)
+    offline_buffer.set_written(first + written, temp_log::logSize());
+
+  if(written > 1)
+  {
+    Serial.print(F("i: backlog "));
+    Serial.println(written);
+  }
+
+  return (offline_buffer.written() == offline_buffer.size());
+}
+
+/// @brief drops buffered samples written before a reset if the log file on the card holds them
+void confirm_backlog()
+{
+  DateTime stamp{};
+  float temperature[temp_log::_NUM_SENSORS_MAX]{0.f};
+
+  if(offline_buffer.written() == 0)
+    return;
+
+  // the newest written sample selects the file its size was taken from
+  offline_buffer.read(offline_buffer.written() - 1, stamp, temperature);
+
+  if(temp_log::fileSize(logtime.filename(stamp)) >= offline_buffer.written_file_size())
+    offline_buffer.discard(offline_buffer.written());
+  else
+    offline_buffer.set_written(0, 0);
+
+  return;
+}
+
+/// @brief restarts the SD card, the wait between two attempts doubles up to _SD_RETRY_CYCLES_MAX
+/// @return true = SD card is available again
+bool retry_sd()
+{
+  if(sd_retry_countdown > 0)
+  {
+    --sd_retry_countdown;
+    return false;
+  }
+
+  if(temp_log::restart_sd_logging(temp_log::pin::_SD))
+  {
+    sd_retry_cycles = 1;
+    return true;
+  }
+
+  sd_retry_countdown = sd_retry_cycles;
+  if(sd_retry_cycles < temp_log::_SD_RETRY_CYCLES_MAX)
+    sd_retry_cycles *= 2;
+
+  return false;
+}
+
 /// @brief helper function to fill loop_state_map arrays with acronyms for terminal debugging
 void fill_loop_state_map()
 {
@@ -262,6 +545,57 @@ void set_onboard_led(bool state)
   return;
 }
 
+/// @brief prints static RAM per subsystem and the current heap / stack status
+void print_memory_report()
+{
+  if(temp_log::static_memory() > temp_log::_RAM_BUDGET_STATIC)
+    Serial.println(F("E: RAM static over budget"));
+
+  Serial.print(F("i: RAM static "));
+  Serial.print(temp_log::static_memory());
+  Serial.print(F(" clk "));
+  Serial.print(ram_clock);
+  Serial.print(F(" sens "));
+  Serial.print(ram_sensors);
+  Serial.print(F(" flt "));
+  Serial.print(ram_filter / temp_log::_NUM_SENSORS_MAX);
+  Serial.print(F("/s"));
+  Serial.print(F(" lcd "));
+  Serial.print(ram_display);
+  Serial.print(F(" sd "));
+  Serial.println(ram_sd);
+
+  Serial.print(F("i: RAM "));
+  Serial.println(temp_log::memory_report(temp_log::memory_status()));
+  return;
+}
+
+/// @brief reads a single character command from the serial terminal and executes it
+void handle_serial_command()
+{
+  if(Serial.available() <= 0)
+    return;
+
+  switch(Serial.read())
+  {
+    case temp_log::cmd::_MEMORY:
+      print_memory_report();
+      break;
+
+    case temp_log::cmd::_SENSORS:
+    {
+      DateTime now{logtime.now()};
+      temp_log::print_record(temp_log::sensors_record(logtime, now, temp_sensor_address));
+      temp_log::print_record(temp_log::resolution_record(logtime, now, sensor_resolution));
+      break;
+    }
+
+    default:
+      break;
+  }
+  return;
+}
+
 //! @brief updates LCD
 void update_display()
 {
@@ -312,6 +646,8 @@ void update_display()
 void loop() {
 
   delay(10);
+
+  handle_serial_command();
   
   switch(state)
   {
@@ -351,24 +687,41 @@ void loop() {
         // Poll all sensors for current temperature
         Serial.println((String) num_connected_sensors + " s"); // DEBUG
 
-        temp_sensors.requestTemperatures();
-        for(unsigned char i{0}; i < num_connected_sensors; ++i)
-        {
-            current_temperature[i] = temp_sensors.getTempC(temp_sensor_address[i]);
-        }
+        measure_temperatures();
+
+      // one timestamp per cycle, also selects the log file
+      DateTime stamp{logtime.now()};
     
       if(temp_log::_SD_LOGGING)
       {
         // log data to SD Card
-        temp_log::log_temperature(logtime, current_temperature);
+        log_cycle(stamp);
+      }
+
+      if(temp_log::_SERIAL_RECORDS)
+      {
+        temp_log::print_record(temp_log::temperature_record(logtime, stamp, current_temperature));
+      }
+
+      // log RAM status every _MEM_LOG_CYCLES measurements
+      if(temp_log::_MEM_LOGGING && (--mem_log_countdown == 0))
+      {
+        mem_log_countdown = temp_log::_MEM_LOG_CYCLES;
+        if(temp_log::_SD_LOGGING && sd_available)
+          temp_log::log_memory(logtime, stamp, temp_log::memory_status());
       }
 
       if(temp_log::_SERIAL_LOGGING)
       {
         for(unsigned char i{0}; i < temp_log::_NUM_SENSORS_MAX; ++i)
         {
-            Serial.println("T" + (String)i + ": " + (String)current_temperature[i] + "°C");
+            Serial.print("T" + (String)i + ": " + (String)current_temperature[i] + "°C ");
+            Serial.print(filter_time_us[i]);
+            Serial.println(F("us"));
         }
+        Serial.print(F("bus: "));
+        Serial.print(bus_time_us);
+        Serial.println(F("us"));
       }
 
       // set next measuring time
@@ -0,0 +1,143 @@
+/*! @file temp_memstat_ds18b20.cpp
+ *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
+ *! @version 1.0
+ *! @date 2026-10-19
+ *! @copyright GPLv3
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "temp_memstat_ds18b20.h"
+
+// avr-libc linker symbols and malloc internals
+extern char __data_start;
+extern char __bss_end;
+extern char __heap_start;
+extern char* __brkval;
+
+struct __freelist
+{
+    size_t sz;
+    struct __freelist* nx;
+};
+extern struct __freelist* __flp;
+
+namespace temp_log
+{
+    // first byte above the heap (the heap grows upwards, the stack downwards)
+    static unsigned char* heap_end()
+    {
+        if(__brkval == nullptr)
+            return reinterpret_cast<unsigned char*>(&__heap_start);
+        return reinterpret_cast<unsigned char*>(__brkval);
+    }
+
+    // highest heap top seen so far: free() lowers __brkval again and leaves
+    // old String data and chunk headers above the new heap top
+    static unsigned char* heap_peak{nullptr};
+
+    static unsigned char* heap_top()
+    {
+        if(heap_end() > heap_peak)
+            heap_peak = heap_end();
+        return heap_peak;
+    }
+
+    void paint_stack()
+    {
+        unsigned char* p{ heap_end() };
+
+        // SP is re-read every iteration, so the current frame is never touched
+        while(p < reinterpret_cast<unsigned char*>(SP))
+        {
+            *p = _STACK_PAINT;
+            ++p;
+        }
+        return;
+    }
+
+    // Longest continuous run of paint between heap and stack. Stray paint
+    // values in old heap or stack data only form short runs and are ignored.
+    unsigned int stack_unused()
+    {
+        unsigned int longest{0};
+        unsigned int run{0};
+
+        for(const unsigned char* p{ heap_top() }; p < reinterpret_cast<unsigned char*>(SP); ++p)
+        {
+            if(*p == _STACK_PAINT)
+            {
+                ++run;
+                if(run > longest)
+                    longest = run;
+            }
+            else
+            {
+                run = 0;
+            }
+        }
+        return longest;
+    }
+
+    unsigned int free_memory()
+    {
+        unsigned int out{ static_cast<unsigned int>(SP - reinterpret_cast<unsigned int>(heap_end())) };
+
+        for(const __freelist* block{__flp}; block != nullptr; block = block->nx)
+        {
+            out += block->sz;
+        }
+        return out;
+    }
+
+    unsigned int largest_free_block()
+    {
+        unsigned int out{ static_cast<unsigned int>(SP - reinterpret_cast<unsigned int>(heap_end())) };
+
+        for(const __freelist* block{__flp}; block != nullptr; block = block->nx)
+        {
+            if(block->sz > out)
+                out = block->sz;
+        }
+        return out;
+    }
+
+    unsigned int static_memory()
+    {
+        return static_cast<unsigned int>(&__bss_end - &__data_start);
+    }
+
+    MemStat memory_status()
+    {
+        MemStat out{};
+        out.free_heap = free_memory();
+        out.largest_block = largest_free_block();
+        out.stack_unused = stack_unused();
+        return out;
+    }
+
+    String memory_report(const MemStat& stat)
+    {
+        String out{ "" };
+        out.reserve(40);
+
+        out += F("free ");
+        out += stat.free_heap;
+        out += F(" blk ");
+        out += stat.largest_block;
+        out += F(" stk ");
+        out += stat.stack_unused;
+
+        return out;
+    }
+}
@@ -0,0 +1,47 @@
+/*! @file temp_memstat_ds18b20.h
+ *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
+ *! @version 1.0
+ *! @date 2026-10-19
+ *! @brief RAM telemetry: free heap, largest free block and stack high-water mark (AVR only)
+ *! @copyright GPLv3
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _TEMP_DS18B20_MEMSTAT_H_
+#define _TEMP_DS18B20_MEMSTAT_H_
+
+#include "Arduino.h"
+
+namespace temp_log
+{
+    constexpr unsigned char _STACK_PAINT{0xC5};
+
+    struct MemStat
+    {
+        unsigned int free_heap;     // gap between heap and stack + freed heap blocks
+        unsigned int largest_block; // largest block malloc() could hand out
+        unsigned int stack_unused;  // never touched by the stack since paint_stack()
+    };
+
+    void paint_stack();
+    unsigned int stack_unused();
+    unsigned int free_memory();
+    unsigned int largest_free_block();
+    unsigned int static_memory();
+    MemStat memory_status();
+    String memory_report(const MemStat& stat);
+}
+
+#endif
@@ -1,7 +1,7 @@
 /*! @file temp_sdlog_ds18b20.cpp
  *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
- *! @version 1.2
- *! @date 2022-12-22 
+ *! @version 1.3
+ *! @date 2026-10-19
  *! @copyright GPLv3
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -21,8 +21,64 @@
 
 namespace temp_log
 {    
+    // Active log file: kept open between writes and only replaced on rollover
+    namespace
+    {
+        File log_file;
+        bool sd_ready{false};
+        bool log_open{false};
+        bool log_batch{false};
+        unsigned long log_period{0};
+
+        // sensor and resolution records are repeated at the top of every new file
+        unsigned char (*log_addresses)[8]{nullptr};
+        const uint8_t* log_resolution{nullptr};
+
+        // boot, sensor and resolution records that could not be written at boot
+        // (no card) go to the first file opened once the card is available
+        bool header_pending{false};
+        DateTime boot_stamp{};
+
+        // flush and close the current file, open the one of stamp's period
+        bool roll_over(const sdlog::LogTime& lt, const DateTime& stamp)
+        {
+            closeLog();
+
+            if(!sd_ready)
+                return false;
+
+            String filename{ lt.filename(stamp) };
+            log_file = SD.open(filename, FILE_WRITE);
+            if(!log_file)
+            {
+                Serial.println("E: " + filename + " no access");
+                return false;
+            }
+
+            log_open = true;
+            log_period = lt.period(stamp);
+
+            // header records only at the top of a new file, not again when the
+            // same file is reopened after a write failure or SD restart
+            if((log_file.size() > 0) && !header_pending)
+                return true;
+
+            if(header_pending)
+                log_file.println(boot_record(lt, boot_stamp));
+            header_pending = false;
+
+            if(log_addresses != nullptr)
+                log_file.println(sensors_record(lt, stamp, log_addresses));
+            if(log_resolution != nullptr)
+                log_file.println(resolution_record(lt, stamp, log_resolution));
+
+            return true;
+        }
+    }
+
     bool init_sd_logging(const unsigned char& sd_pin){
-        if(!SD.begin(sd_pin)){
+        sd_ready = SD.begin(sd_pin);
+        if(!sd_ready){
             Serial.println(F("E: SD fail"));
             return false;
         }
@@ -31,10 +87,27 @@ namespace temp_log
         return true;
     }
 
+    // retry after the card was missing or pulled
+    bool restart_sd_logging(const unsigned char& sd_pin){
+        closeLog();
+        SD.end();
+        return init_sd_logging(sd_pin);
+    }
+
     bool fileExists(const String& filename){
         return SD.exists(filename);
     }
 
+    uint32_t fileSize(const String& filename){
+        File file = SD.open(filename);
+        if(!file)
+            return 0;
+
+        uint32_t out{ file.size() };
+        file.close();
+        return out;
+    }
+
     bool deleteFile(const String& filename){
         return SD.remove(filename);
     }
@@ -52,6 +125,86 @@ namespace temp_log
         return true;
     }
 
+    bool appendToLog(const sdlog::LogTime& lt, const DateTime& stamp, const String& text)
+    {
+        if(!log_open || (lt.period(stamp) != log_period))
+        {
+            if(!roll_over(lt, stamp))
+                return false;
+        }
+
+        // a failed write usually means the card is gone: reopen on the next call
+        if(log_file.println(text) == 0)
+        {
+            closeLog();
+            return false;
+        }
+
+        if(!log_batch)
+            log_file.flush();
+        return true;
+    }
+
+    void closeLog()
+    {
+        if(log_open)
+        {
+            log_file.flush();
+            log_file.close();
+        }
+        log_open = false;
+        return;
+    }
+
+    // records written until endLogBatch() are flushed together
+    void beginLogBatch()
+    {
+        log_batch = true;
+        return;
+    }
+
+    void endLogBatch()
+    {
+        log_batch = false;
+        if(log_open)
+            log_file.flush();
+        return;
+    }
+
+    // The SD library cannot report a failed flush and keeps accepting writes while
+    // the current block is cached. To prove that the records reached the card, it
+    // is re-initialised (empty cache) and the file size in the directory entry is
+    // compared with the number of bytes written. The log is closed afterwards.
+    bool confirmLog(const unsigned char& sd_pin)
+    {
+        if(!log_open)
+            return false;
+
+        log_file.flush();
+        uint32_t written{ log_file.size() };
+        char filename[13]{};
+        strncpy(filename, log_file.name(), sizeof(filename) - 1);
+
+        if(!restart_sd_logging(sd_pin))
+            return false;
+
+        File check = SD.open(filename);
+        if(!check)
+            return false;
+
+        bool confirmed{ check.size() == written };
+        check.close();
+        return confirmed;
+    }
+
+    // size of the open log file, 0 if none is open
+    uint32_t logSize()
+    {
+        if(!log_open)
+            return 0;
+        return log_file.size();
+    }
+
     String readFile(const String& filename)
     {
         String out{ "" };
@@ -76,26 +229,39 @@ namespace temp_log
         return out;
     }
 
-    void log_boot(const sdlog::LogTime& lt)
+    void log_boot(const sdlog::LogTime& lt, const DateTime& stamp)
+    {
+        boot_stamp = stamp;
+
+        if(!appendToLog(lt, stamp, boot_record(lt, stamp)))
+            header_pending = true;
+    
+        return;
+    }
+
+    String boot_record(const sdlog::LogTime& lt, const DateTime& stamp)
     {
         String out{ "" };
         
         // Generate Output for logging
-        out += lt.iso_now(false, false);
+        out += lt.iso(stamp, false, false);
         lt.append_separator(out);
         out += _LOG_BOOT;
-        
-        appendToFile(out, lt.current_filename());
-    
-        return;
+
+        return out;
     }
 
-    void log_temperature(const sdlog::LogTime& lt, float current_temperature[temp_log::_NUM_SENSORS_MAX])
+    bool log_temperature(const sdlog::LogTime& lt, const DateTime& stamp, float current_temperature[temp_log::_NUM_SENSORS_MAX])
+    {
+        return appendToLog(lt, stamp, temperature_record(lt, stamp, current_temperature));
+    }
+
+    String temperature_record(const sdlog::LogTime& lt, const DateTime& stamp, float current_temperature[temp_log::_NUM_SENSORS_MAX])
     {
         String out{ "" };
         out.reserve(temp_log::_NUM_SENSORS_MAX * 5 + 13);
         
-        out += lt.iso_now(false, false);
+        out += lt.iso(stamp, false, false);
         lt.append_separator(out);
         out += _LOG_TEMP;
         lt.append_separator(out);
@@ -108,35 +274,91 @@ namespace temp_log
                 lt.append_separator(out);
             }
         }
-        appendToFile(out, lt.current_filename());
-
-        return;
+        return out;
     }
 
-    void log_sensors(const sdlog::LogTime& lt, unsigned char addresses[temp_log::_NUM_SENSORS_MAX][8])
+    String sensors_record(const sdlog::LogTime& lt, const DateTime& stamp, unsigned char addresses[temp_log::_NUM_SENSORS_MAX][8])
     {
         String out{ "" };
         out.reserve(temp_log::_NUM_SENSORS_MAX * 17 + 13);
-        
-        out += lt.iso_now(false, false);
+
+        out += lt.iso(stamp, false, false);
         lt.append_separator(out);
         out += _LOG_SENSORS;
         lt.append_separator(out);
 
         for(unsigned char i{0}; i < temp_log::_NUM_SENSORS_MAX; ++i)
         {
-            for(unsigned char j{0}; j < 8; ++j)
+            out += sensor_address_to_string(addresses[i]);
+
+            if(i < temp_log::_NUM_SENSORS_MAX - 1)
             {
-                out += byte_to_hex(addresses[i][j]);
+                lt.append_separator(out);
             }
+        }
+        return out;
+    }
+
+    // Resolution in bits per sensor, same column order as the sensor record
+    String resolution_record(const sdlog::LogTime& lt, const DateTime& stamp, const uint8_t resolution[temp_log::_NUM_SENSORS_MAX])
+    {
+        String out{ "" };
+        out.reserve(temp_log::_NUM_SENSORS_MAX * 3 + 13);
+
+        out += lt.iso(stamp, false, false);
+        lt.append_separator(out);
+        out += _LOG_RESOLUTION;
+        lt.append_separator(out);
+
+        for(unsigned char i{0}; i < temp_log::_NUM_SENSORS_MAX; ++i)
+        {
+            out += resolution[i];
 
             if(i < temp_log::_NUM_SENSORS_MAX - 1)
             {
                 lt.append_separator(out);
             }
         }
+        return out;
+    }
+
+    // Records on the serial terminal get the prefix "d: " to tell them apart from
+    // the "i: " / "E: " messages. They use the same format as the CSV lines.
+    void print_record(const String& record)
+    {
+        Serial.print(F("d: "));
+        Serial.println(record);
+        return;
+    }
+
+    void log_sensors(const sdlog::LogTime& lt, const DateTime& stamp, unsigned char addresses[temp_log::_NUM_SENSORS_MAX][8], const uint8_t resolution[temp_log::_NUM_SENSORS_MAX])
+    {
+        if(!appendToLog(lt, stamp, sensors_record(lt, stamp, addresses))
+           || !appendToLog(lt, stamp, resolution_record(lt, stamp, resolution)))
+            header_pending = true;
+
+        log_addresses = addresses;
+        log_resolution = resolution;
+
+        return;
+    }
+
+    void log_memory(const sdlog::LogTime& lt, const DateTime& stamp, const MemStat& stat)
+    {
+        String out{ "" };
+        out.reserve(40);
+
+        out += lt.iso(stamp, false, false);
+        lt.append_separator(out);
+        out += _LOG_MEMORY;
+        lt.append_separator(out);
+        out += stat.free_heap;
+        lt.append_separator(out);
+        out += stat.largest_block;
+        lt.append_separator(out);
+        out += stat.stack_unused;
 
-        appendToFile(out, lt.current_filename());
+        appendToLog(lt, stamp, out);
 
         return;
     }
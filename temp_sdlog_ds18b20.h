@@ -1,7 +1,7 @@
 /*! @file temp_sdlog_ds18b20.h
  *! @author Tobias Rolke (github.com/randomguyfromtheinternet/)
- *! @version 1.1
- *! @date 2022-11-19 
+ *! @version 1.2
+ *! @date 2026-10-19
  *! @copyright GPLv3
     This program is free software: you can redistribute it and/or modify
     it under the terms of the GNU General Public License as published by
@@ -25,25 +25,43 @@
 #include <SD.h> // SD by Arduino
 #include "logtime.h"
 #include "temp_settings_ds18b20.h"
+#include "temp_memstat_ds18b20.h"
 
 namespace temp_log
 {
     constexpr char _LOG_BOOT{'b'};
     constexpr char _LOG_SENSORS{'s'};
     constexpr char _LOG_TEMP{'t'};
+    constexpr char _LOG_MEMORY{'m'};
+    constexpr char _LOG_RESOLUTION{'r'};
 
     bool init_sd_logging(const unsigned char& sd_pin);
+    bool restart_sd_logging(const unsigned char& sd_pin);
     bool fileExists(const String& filename);
+    uint32_t fileSize(const String& filename);
     bool deleteFile(const String& filename);
     bool appendToFile(const String& text, const String& filename);
+    bool appendToLog(const sdlog::LogTime& lt, const DateTime& stamp, const String& text);
+    void closeLog();
+    void beginLogBatch();
+    void endLogBatch();
+    bool confirmLog(const unsigned char& sd_pin);
+    uint32_t logSize();
     String readFile(const String& filename);
     String sensor_address_to_string(unsigned char address[8]);
     String byte_to_hex(const unsigned char& input);
     char subbyte_to_hex(const unsigned char& slice);
 
-    void log_boot(const sdlog::LogTime& lt);
-    void log_temperature(const sdlog::LogTime& lt, float current_temperature[temp_log::_NUM_SENSORS_MAX]);
-    void log_sensors(const sdlog::LogTime& lt, unsigned char addresses[temp_log::_NUM_SENSORS_MAX][8]);
+    void log_boot(const sdlog::LogTime& lt, const DateTime& stamp);
+    bool log_temperature(const sdlog::LogTime& lt, const DateTime& stamp, float current_temperature[temp_log::_NUM_SENSORS_MAX]);
+    void log_sensors(const sdlog::LogTime& lt, const DateTime& stamp, unsigned char addresses[temp_log::_NUM_SENSORS_MAX][8], const uint8_t resolution[temp_log::_NUM_SENSORS_MAX]);
+    void log_memory(const sdlog::LogTime& lt, const DateTime& stamp, const MemStat& stat);
+
+    String boot_record(const sdlog::LogTime& lt, const DateTime& stamp);
+    String temperature_record(const sdlog::LogTime& lt, const DateTime& stamp, float current_temperature[temp_log::_NUM_SENSORS_MAX]);
+    String sensors_record(const sdlog::LogTime& lt, const DateTime& stamp, unsigned char addresses[temp_log::_NUM_SENSORS_MAX][8]);
+    String resolution_record(const sdlog::LogTime& lt, const DateTime& stamp, const uint8_t resolution[temp_log::_NUM_SENSORS_MAX]);
+    void print_record(const String& record);
 }
 
 #endif
\ No newline at end of file
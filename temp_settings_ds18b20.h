@@ -23,15 +23,66 @@
 #define _TEMP_DS18B20_SETTINGS_H_
 
 #include "Arduino.h"
+#include "logtime.h"
 
 namespace temp_log
 {
     constexpr bool _SERIAL_LOGGING{true};
+    constexpr bool _SERIAL_RECORDS{true}; // CSV records on serial, prefixed "d: "
     constexpr bool _SD_LOGGING{true};
+    constexpr bool _OFFLINE_BUFFER{true}; // buffer samples in NVRAM / EEPROM without SD card
+    constexpr unsigned int _SD_CHECKPOINT_CYCLES{10u}; // cycles between two checks that the samples are on the card
+    constexpr unsigned int _SD_RETRY_CYCLES_MAX{16u}; // longest wait between two SD restarts while the card is missing
+    constexpr sdlog::Rollover _LOG_ROLLOVER{sdlog::Rollover::monthly}; // one log file per day, week or month
     constexpr unsigned int _NUM_SENSORS_MAX{3u};
     constexpr unsigned char _LCD_ROWS{20};
     constexpr unsigned char _LCD_LINES{4};
 
+    // Filter: _FILTER_SAMPLES conversions per sensor and cycle, median is logged
+    constexpr unsigned char _FILTER_SAMPLES{5u};
+
+    // Resolution in bits (9..12) per sensor ROM code, as printed in the 's' record.
+    // Sensors not listed here use _SENSOR_RESOLUTION_DEFAULT, unused entries stay 0.
+    // Conversion time doubles per bit: 94 ms at 9 bit up to 750 ms at 12 bit.
+    struct SensorResolution
+    {
+        unsigned char address[8];
+        uint8_t bits;
+    };
+
+    constexpr uint8_t _SENSOR_RESOLUTION_DEFAULT{10};
+    constexpr SensorResolution _SENSOR_RESOLUTION[_NUM_SENSORS_MAX]{
+        // {{0x28, 0xFF, 0x64, 0x1E, 0x0F, 0x2B, 0x4C, 0x3A}, 12},
+    };
+
+    constexpr bool is_resolution(const uint8_t& bits)
+    {
+        return (bits >= 9) && (bits <= 12);
+    }
+
+    constexpr bool resolution_table_valid(const unsigned char i = 0)
+    {
+        return (i >= _NUM_SENSORS_MAX)
+            || (((_SENSOR_RESOLUTION[i].bits == 0) || is_resolution(_SENSOR_RESOLUTION[i].bits))
+                && resolution_table_valid(i + 1));
+    }
+
+    static_assert(is_resolution(_SENSOR_RESOLUTION_DEFAULT), "DS18B20 resolution is 9..12 bit");
+    static_assert(resolution_table_valid(), "DS18B20 resolution is 9..12 bit, see _SENSOR_RESOLUTION");
+
+    // RAM telemetry
+    constexpr bool _MEM_LOGGING{true};
+    constexpr unsigned int _MEM_LOG_CYCLES{60u}; // measuring cycles between two 'm' records
+    constexpr unsigned int _RAM_BUDGET_STATIC{1536u}; // .data + .bss, checked at boot
+    constexpr unsigned int _RAM_BUDGET_OBJECTS{900u}; // only the global objects listed in the sketch
+
+    // single character commands read from the serial terminal
+    namespace cmd
+    {
+        constexpr char _MEMORY{'m'};
+        constexpr char _SENSORS{'s'}; // repeat the sensor record, e.g. after a host connected
+    }
+
     namespace pin
     {
         constexpr uint8_t _TEMP_SENSOR{2};